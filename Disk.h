@@ -6,7 +6,7 @@
 #include <vector>
 #include <string>
 #include <deque>
-#include "PCB.h"
+#include "Pcb.h"
 #include "FileReadRequest.h"
 #include <iostream>
 class Disk {
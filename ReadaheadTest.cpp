@@ -0,0 +1,288 @@
+// Checked driver for the paging readahead in SimOS
+// Build and run : g++ -std=c++17 ReadaheadTest.cpp -o ReadaheadTest && ./ReadaheadTest
+
+#include "SimOS.h"
+#include <iostream>
+#include <climits>
+
+int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cout << "FAILED line " << __LINE__ << ": " << #condition << std::endl; \
+            failures++; \
+        } \
+    } while (false)
+
+/**
+    @return : true if the page of the process is in memory, false otherwise
+*/
+bool inMemory(const SimOS &os, int pid, unsigned long long pageNumber){
+    for (const MemoryItem &item : os.GetMemory()) {
+        if (item.PID == pid && item.pageNumber == pageNumber) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+    @return : the demand faults caused by accessing the page
+*/
+unsigned long long faultsOf(SimOS &os, unsigned long long pageNumber){
+    unsigned long long before = os.GetPrefetchStats().demandFaults;
+    os.AccessMemoryAddress(pageNumber);
+    return os.GetPrefetchStats().demandFaults - before;
+}
+
+void testOffByDefault(){
+    SimOS os(1, 64, 1);
+    os.NewProcess();
+
+    for (unsigned long long page = 0; page < 10; page++) {
+        os.AccessMemoryAddress(page);
+    }
+
+    PrefetchStats stats = os.GetPrefetchStats();
+    CHECK(stats.issued == 0);
+    CHECK(stats.demandFaults == 10);
+    CHECK(os.GetMemory().size() == 10);
+    CHECK(!inMemory(os, 1, 10));
+    CHECK(stats.accuracy() == 0.0);
+    CHECK(stats.coverage() == 0.0);
+}
+
+void testDisabledBySetReadahead(){
+    for (int variant = 0; variant < 2; variant++) {
+        SimOS os(1, 64, 1);
+        os.NewProcess();
+        os.SetReadahead(variant == 0 ? 0 : 16, variant == 0 ? 2 : 0);
+
+        for (unsigned long long page = 0; page < 10; page++) {
+            os.AccessMemoryAddress(page);
+        }
+
+        CHECK(os.GetPrefetchStats().issued == 0);
+        CHECK(os.GetPrefetchStats().demandFaults == 10);
+    }
+}
+
+void testSequential(){
+    SimOS os(1, 64, 1);
+    os.NewProcess();
+    os.SetReadahead(16, 2);
+
+    os.AccessMemoryAddress(0);
+    os.AccessMemoryAddress(1);
+    CHECK(!inMemory(os, 1, 2)); // One stride is not enough to confirm a stream
+
+    os.AccessMemoryAddress(2);
+    CHECK(inMemory(os, 1, 3));
+
+    for (unsigned long long page = 3; page < 200; page++) {
+        os.AccessMemoryAddress(page);
+    }
+
+    PrefetchStats stats = os.GetPrefetchStats();
+    CHECK(stats.demandFaults == 3);
+    CHECK(stats.useful == 197);
+    CHECK(stats.issued <= stats.useful + 16);
+    CHECK(stats.accuracy() > 0.9);
+    CHECK(stats.coverage() > 0.9);
+    CHECK(os.GetMemory().size() <= 64);
+}
+
+void testBackwardStride(){
+    SimOS os(1, 64, 1);
+    os.NewProcess();
+    os.SetReadahead(8, 2);
+
+    for (unsigned long long page = 100; page >= 60; page -= 2) {
+        os.AccessMemoryAddress(page);
+    }
+
+    CHECK(os.GetPrefetchStats().demandFaults == 3);
+    CHECK(inMemory(os, 1, 58));
+    CHECK(!inMemory(os, 1, 59));
+
+    // A stream heading below page 0 stops instead of wrapping
+    SimOS low(1, 64, 1);
+    low.NewProcess();
+    low.SetReadahead(8, 2);
+    low.AccessMemoryAddress(2);
+    low.AccessMemoryAddress(1);
+    low.AccessMemoryAddress(0);
+    CHECK(low.GetMemory().size() == 3);
+}
+
+void testInterleavedStreams(){
+    SimOS os(1, 64, 1);
+    os.NewProcess();
+    os.SetReadahead(8, 2);
+
+    for (unsigned long long page = 0; page < 50; page++) {
+        os.AccessMemoryAddress(page);
+        os.AccessMemoryAddress(1000 + page);
+    }
+
+    CHECK(os.GetPrefetchStats().demandFaults == 6);
+}
+
+void testStrayAccessKeepsStream(){
+    SimOS os(1, 64, 1);
+    os.NewProcess();
+    os.SetReadahead(8, 2);
+
+    unsigned long long faults = 0;
+    for (unsigned long long page = 0; page < 40; page++) {
+        faults += faultsOf(os, page);
+        if (page == 20) {
+            faults += faultsOf(os, 5000);
+        }
+    }
+
+    CHECK(faults == 4); // Three to confirm the stream and the stray page itself
+}
+
+void testWindowShrinksOnWaste(){
+    SimOS os(1, 32, 1);
+    os.NewProcess();
+    os.SetReadahead(8, 2);
+
+    // Short streams that stop early leave prefetched pages unused until demand faults evict them
+    for (unsigned long long run = 0; run < 20; run++) {
+        unsigned long long base = run * 10000;
+        for (unsigned long long page = base; page < base + 4; page++) {
+            os.AccessMemoryAddress(page);
+        }
+    }
+
+    PrefetchStats stats = os.GetPrefetchStats();
+    CHECK(stats.wasted > 0);
+    CHECK(stats.accuracy() < 1.0);
+    CHECK(stats.useful + stats.wasted <= stats.issued);
+}
+
+void testLargeWindowLimit(){
+    SimOS os(1, 2048, 1);
+    os.NewProcess();
+    os.SetReadahead(UINT_MAX, 2);
+
+    for (unsigned long long page = 0; page < 4000; page++) {
+        os.AccessMemoryAddress(page);
+    }
+
+    // The window keeps growing up to the limit without wrapping around to 0
+    CHECK(os.GetPrefetchStats().demandFaults == 3);
+}
+
+void testAccessedPageSurvivesReadahead(){
+    for (unsigned long long frames = 1; frames <= 2; frames++) {
+        SimOS os(1, frames, 1);
+        os.NewProcess();
+        os.SetReadahead(8, 2);
+
+        os.AccessMemoryAddress(0);
+        os.AccessMemoryAddress(1);
+        os.AccessMemoryAddress(2);
+
+        CHECK(inMemory(os, 1, 2));
+        CHECK(os.GetMemory().size() == frames);
+    }
+}
+
+void testAddressSpaceEdges(){
+    SimOS os(1, 64, 1);
+    os.NewProcess();
+    os.SetReadahead(8, 2);
+
+    os.AccessMemoryAddress(LLONG_MAX - 2ULL);
+    os.AccessMemoryAddress(LLONG_MAX - 1ULL);
+    os.AccessMemoryAddress(LLONG_MAX);
+    CHECK(inMemory(os, 1, static_cast<unsigned long long>(LLONG_MAX) + 1));
+
+    os.AccessMemoryAddress(ULLONG_MAX - 2);
+    os.AccessMemoryAddress(ULLONG_MAX - 1);
+    os.AccessMemoryAddress(ULLONG_MAX);
+    CHECK(inMemory(os, 1, ULLONG_MAX));
+}
+
+/**
+    @return : the demand faults taken by a process re-touching hot pages while four other processes stream
+*/
+unsigned long long hotSetFaults(unsigned int window){
+    SimOS os(1, 24, 1);
+    for (int i = 0; i < 5; i++) {
+        os.NewProcess();
+    }
+    os.SetReadahead(window, 2);
+
+    unsigned long long hotFaults = 0;
+    unsigned long long nextPage[6] = {0};
+    for (int round = 0; round < 200; round++) {
+        for (int turn = 0; turn < 5; turn++) {
+            int pid = os.GetCPU();
+            if (pid == 1) {
+                for (unsigned long long page = 0; page < 6; page += 2) {
+                    hotFaults += faultsOf(os, page);
+                }
+            } else {
+                os.AccessMemoryAddress(pid * 100000ULL + nextPage[pid]++);
+            }
+            os.TimerInterrupt();
+        }
+    }
+
+    return hotFaults;
+}
+
+void testMultiProcessHotSet(){
+    unsigned long long withoutReadahead = hotSetFaults(0);
+    unsigned long long withReadahead = hotSetFaults(6);
+
+    CHECK(withoutReadahead == 3);
+    CHECK(withReadahead <= withoutReadahead);
+}
+
+void testExitReleasesPrefetchedPages(){
+    SimOS os(1, 16, 1);
+    os.NewProcess();
+    os.SetReadahead(4, 2);
+
+    for (unsigned long long page = 0; page < 8; page++) {
+        os.AccessMemoryAddress(page);
+    }
+    os.SimExit();
+    CHECK(os.GetMemory().empty());
+
+    // Released frames are reused from the lowest number
+    os.NewProcess();
+    os.AccessMemoryAddress(100);
+    CHECK(os.GetMemory().size() == 1);
+    CHECK(os.GetMemory()[0].frameNumber == 0);
+}
+
+int main(){
+    testOffByDefault();
+    testDisabledBySetReadahead();
+    testSequential();
+    testBackwardStride();
+    testInterleavedStreams();
+    testStrayAccessKeepsStream();
+    testWindowShrinksOnWaste();
+    testLargeWindowLimit();
+    testAccessedPageSurvivesReadahead();
+    testAddressSpaceEdges();
+    testMultiProcessHotSet();
+    testExitReleasesPrefetchedPages();
+
+    if (failures > 0) {
+        std::cout << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All readahead checks passed" << std::endl;
+    return 0;
+}
@@ -6,12 +6,15 @@
 #include <vector>
 #include <string>
 #include <deque>
-#include "PCB.h"
+#include "Pcb.h"
 #include "Disk.h"
 #include "FileReadRequest.h"
 #include <unordered_map>
 #include <set> 
 #include <algorithm>
+#include <iterator>
+#include <climits>
+#include <stdexcept>
 
 struct MemoryItem
 {
@@ -24,6 +27,49 @@ using MemoryUsage = std::vector<MemoryItem>;
  
 constexpr int NO_PROCESS{ 0 };
 
+constexpr unsigned int DEFAULT_SEQUENTIAL_THRESHOLD{ 2 }; // Same stride seen this many times in a row before reading ahead
+constexpr unsigned int MIN_READAHEAD_WINDOW{ 1 };         // Pages read ahead when a stream is first detected
+
+constexpr unsigned int READAHEAD_STREAMS{ 4 };            // Streams tracked per process, so interleaved streams are each detected
+constexpr unsigned long long READAHEAD_MAX_STRIDE{ 64 }; // Larger jumps start a new stream instead of training an existing one
+
+// One access stream of a process, the stride is kept as a length and a direction so page numbers never overflow
+struct ReadaheadStream
+{
+    unsigned long long lastPage{0};
+    unsigned long long strideLength{0};
+    bool forward{true};
+    unsigned int streak{0}; // Times in a row the stride has been seen, 0 while the stride is unknown
+    unsigned int prefetchedAhead{0}; // Strides past lastPage already read ahead, so each access only issues new pages
+};
+
+// Per process sequential access detector
+struct ReadaheadState
+{
+    std::deque<ReadaheadStream> streams; // Most recently used stream first
+    unsigned int window{MIN_READAHEAD_WINDOW};
+    unsigned int outstanding{0}; // Pages prefetched for this process but not yet accessed
+};
+
+struct PrefetchStats
+{
+    unsigned long long issued{0};       // Pages brought in by readahead
+    unsigned long long useful{0};       // Prefetched pages that were accessed before eviction
+    unsigned long long wasted{0};       // Prefetched pages evicted without being accessed
+    unsigned long long demandFaults{0}; // Accesses that missed and had to load the page on demand
+
+    /* Returns the fraction of prefetched pages that were accessed */
+    double accuracy() const {
+        return issued == 0 ? 0.0 : static_cast<double>(useful) / issued;
+    }
+
+    /* Returns the fraction of would-be faults that readahead removed */
+    double coverage() const {
+        unsigned long long misses = useful + demandFaults;
+        return misses == 0 ? 0.0 : static_cast<double>(useful) / misses;
+    }
+};
+
 class SimOS
 {
     public:
@@ -253,6 +299,8 @@ class SimOS
         auto it = memoryUsage.begin();
         while (it != memoryUsage.end()) {
             if (it->PID == currentPID) {
+                freeFrames.insert(it->frameNumber);
+                residentPages.erase({it->PID, it->pageNumber});
                 it = memoryUsage.erase(it); 
             } else {
                 ++it;
@@ -326,9 +374,11 @@ class SimOS
     /**
         @post : Accesses the memory address
             If there is no process currently using the CPU, a logic_error exception will be thrown
-            The memory address will be accessed and added to the memoryUsage and lru list
-            If the memory address is already in memory, the memory item will be updated and moved to the front of the lru list
-            if the memory is full, the least recently used memory item and lru list will be removed and the new memory item will be added to the memoryUsage and lru list
+            If the memory address is already in memory, the memory item will be moved to the front of the lru list
+            If the memory address is not in memory, it will be loaded into a free frame, or into the frame of the
+                least recently used memory item if the memory is full
+            If readahead was enabled with SetReadahead, the access is then fed to the sequential access detector of the
+                process, which may load upcoming pages the process has not accessed yet, GetMemory will show those pages
     */
     void AccessMemoryAddress(unsigned long long address){
         if (currentPID == NO_PROCESS) {
@@ -337,35 +387,259 @@ class SimOS
 
         unsigned long long pageNumber = address / pageSize;
 
-        // Check if the memory is full
-        bool isFull = memoryUsage.size() == static_cast<size_t>(maxFrames);
+        // If the page number is in memory move it to the front of the lru list since we accessed it
+        if (isPageAddressInMemory(pageNumber)) {
+            touchMemoryItem(pageNumber);
+        } else {
+            prefetchStats.demandFaults++;
 
-        // Check if the page number is in memory
-        bool pageNumberFound = isPageAddressInMemory(pageNumber);
-        
-        // If the page number is not in memory and the memory is not full add the Memory item item to memory and lru list
-        if (!pageNumberFound && !isFull) {
-            unsigned long long frameNumber = frameCounter; 
-            frameCounter++;
-            
-            MemoryItem newItem{pageNumber, frameNumber, currentPID};
-
-            memoryUsage.push_back({newItem});
+            // If the memory is full the least recently used memory item gives up its frame
+            if (memoryUsage.size() >= static_cast<size_t>(maxFrames)) {
+                evictLeastRecentlyUsed();
+            }
+
+            loadPage(pageNumber, false);
+        }
+
+        readAhead(pageNumber);
+    }
+
+    /**
+        @post : Moves the memory item of the current process to the front of the lru list
+            If the memory item was brought in by a readahead, the prefetch is counted as useful and the readahead window grows
+    */
+    void touchMemoryItem(unsigned long long pageNumber){
+        for (auto it = lruList.begin(); it != lruList.end(); ++it) {
+            if (it->PID == currentPID && it->pageNumber == pageNumber) {
+                MemoryItem item = *it;
+                lruList.erase(it);
+                lruList.push_front(item);
+                break;
+            }
+        }
+
+        if (prefetchedPages.erase({currentPID, pageNumber}) > 0) {
+            prefetchStats.useful++;
+
+            ReadaheadState &state = readaheadStates[currentPID];
+            state.outstanding--;
+            if (state.window <= readaheadWindowLimit / 2) {
+                state.window *= 2;
+            } else {
+                state.window = std::max(readaheadWindowLimit, MIN_READAHEAD_WINDOW);
+            }
+        }
+    }
+
+    /**
+        @post : Loads the page of the current process into the lowest free frame
+            Demand loaded pages are placed at the front of the lru list
+            Prefetched pages are placed at the back of the lru list so they are evicted before the working set
+    */
+    void loadPage(unsigned long long pageNumber, bool prefetched){
+        MemoryItem newItem{pageNumber, allocateFrame(), currentPID};
+        memoryUsage.push_back(newItem);
+        residentPages.insert({currentPID, pageNumber});
+
+        if (prefetched) {
+            lruList.push_back(newItem);
+            prefetchedPages.insert({currentPID, pageNumber});
+        } else {
             lruList.push_front(newItem);
-        } else if (pageNumberFound) { // If the page address is in memory update the lru memory item and move it to the front of the lru list
-            MemoryItem &lruItem = lruList.back();
-            lruList.pop_back();
+        }
+    }
+
+    /**
+        @post : Removes the least recently used memory item from memoryUsage and the lru list
+            If the memory item was prefetched and never accessed, the prefetch is counted as wasted and the
+            readahead window of its process shrinks
+    */
+    void evictLeastRecentlyUsed(){
+        if (lruList.empty()) {
+            return;
+        }
+
+        evictMemoryItem(std::prev(lruList.end()));
+    }
+
+    /**
+        @post : Removes the memory item pointed to by the iterator from memoryUsage and the lru list
+    */
+    void evictMemoryItem(std::deque<MemoryItem>::iterator victim){
+        MemoryItem item = *victim;
+        lruList.erase(victim);
+        deleteMemoryItem(item);
+
+        if (prefetchedPages.erase({item.PID, item.pageNumber}) > 0) {
+            prefetchStats.wasted++;
+
+            auto state = readaheadStates.find(item.PID);
+            if (state != readaheadStates.end()) {
+                state->second.outstanding--;
+                state->second.window = std::max(state->second.window / 2, MIN_READAHEAD_WINDOW);
+            }
+        }
+    }
+
+    /**
+        @post : Records the access in the sequential access detector of the current process
+            An access that continues a stream advances it, any other access trains the nearest stream whose
+            stride is not yet confirmed, or starts a new stream, so a stray access does not break a confirmed stream
+            Once a stream has seen the same stride sequentialThreshold times in a row, the next window pages
+            along the stride are prefetched, the window never exceeds readaheadWindowLimit
+            Prefetching only uses free frames or the frame of the least recently used demand loaded page of the
+            current process other than the page just accessed, and stops once readaheadWindowLimit pages of the current process are
+            prefetched but not yet accessed
+    */
+    void readAhead(unsigned long long pageNumber){
+        if (readaheadWindowLimit == 0 || sequentialThreshold == 0) {
+            return; // Readahead is disabled
+        }
+
+        ReadaheadState &state = readaheadStates[currentPID];
+
+        auto matched = state.streams.end();
+        auto nearest = state.streams.end();
+        unsigned long long nearestDistance = READAHEAD_MAX_STRIDE + 1;
+
+        for (auto it = state.streams.begin(); it != state.streams.end(); ++it) {
+            if (it->lastPage == pageNumber) {
+                return; // Repeated access to the same page says nothing about the stride
+            }
+
+            unsigned long long expectedPage = it->lastPage;
+            if (it->streak > 0 && nextStridePage(*it, expectedPage) && expectedPage == pageNumber) {
+                matched = it;
+                break;
+            }
 
-            updateMemoryItem(lruItem); // Find LRU and Update it
-            
-            lruItem.PID = currentPID;
-            lruList.push_front(lruItem); // Move to the front of the list since we accessed it
-        } else if (isFull) { // If the memory is full remove the least recently used memory item and lru item are removed 
-            MemoryItem &lruItem = lruList.back();
-            lruList.pop_back(); // Remove the least recently used item
+            unsigned long long distance = pageDistance(it->lastPage, pageNumber);
+            if (it->streak < sequentialThreshold && distance < nearestDistance) {
+                nearest = it;
+                nearestDistance = distance;
+            }
+        }
+
+        ReadaheadStream stream;
+        if (matched != state.streams.end()) {
+            stream = *matched;
+            stream.streak++;
+            if (stream.prefetchedAhead > 0) {
+                stream.prefetchedAhead--;
+            }
+            state.streams.erase(matched);
+        } else if (nearest != state.streams.end()) {
+            stream = *nearest;
+            stream.strideLength = nearestDistance;
+            stream.forward = pageNumber > stream.lastPage;
+            stream.streak = 1;
+            stream.prefetchedAhead = 0;
+            state.streams.erase(nearest);
+        } else if (state.streams.size() >= READAHEAD_STREAMS) {
+            state.streams.pop_back(); // Replace the least recently used stream
+        }
+
+        stream.lastPage = pageNumber;
+        state.streams.push_front(stream);
+
+        ReadaheadStream &current = state.streams.front();
+        if (current.streak < sequentialThreshold) {
+            return;
+        }
+
+        // Resume after the pages this stream already read ahead, they were reachable so this cannot wrap
+        unsigned long long skipped = static_cast<unsigned long long>(current.prefetchedAhead) * current.strideLength;
+        unsigned long long page = current.forward ? pageNumber + skipped : pageNumber - skipped;
+
+        unsigned int window = std::min(state.window, readaheadWindowLimit);
+        while (current.prefetchedAhead < window) {
+            if (!nextStridePage(current, page)) {
+                break; // The stream runs off the end of the address space
+            }
+
+            if (!isPageAddressInMemory(page)) {
+                if (!makeRoomForPrefetch(state, pageNumber)) {
+                    break;
+                }
+
+                loadPage(page, true);
+                state.outstanding++;
+                prefetchStats.issued++;
+            }
+
+            current.prefetchedAhead++;
+        }
+    }
 
-            deleteMemoryItem(lruItem); // Delete the LRU item from memory usage
+    /**
+        @post : Moves the page one stride along the stream
+        @return : false if the step would wrap around the address space, true otherwise
+    */
+    bool nextStridePage(const ReadaheadStream &stream, unsigned long long &page) const {
+        if (stream.forward) {
+            if (page > ULLONG_MAX - stream.strideLength) {
+                return false;
+            }
+            page += stream.strideLength;
+        } else {
+            if (page < stream.strideLength) {
+                return false;
+            }
+            page -= stream.strideLength;
         }
+
+        return true;
+    }
+
+    /**
+        @return : the number of pages between the two page numbers
+    */
+    unsigned long long pageDistance(unsigned long long a, unsigned long long b) const {
+        return a > b ? a - b : b - a;
+    }
+
+    /**
+        @param : The readahead state of the current process (a ReadaheadState)
+        @param : The page whose access triggered the readahead (a unsigned long long)
+
+        @return : true if a frame is available for a prefetched page, false otherwise
+            False if the current process already has readaheadWindowLimit pages prefetched but not yet accessed
+            If the memory is full, the least recently used page of the current process that was not itself
+            prefetched and is not the page just accessed is evicted, pages of other processes are never evicted
+            so one process's readahead cannot push out another's working set
+    */
+    bool makeRoomForPrefetch(const ReadaheadState &state, unsigned long long accessedPage){
+        if (state.outstanding >= readaheadWindowLimit) {
+            return false;
+        }
+
+        if (memoryUsage.size() < static_cast<size_t>(maxFrames)) {
+            return true;
+        }
+
+        for (auto it = lruList.end(); it != lruList.begin(); ) {
+            --it;
+            bool accessed = it->PID == currentPID && it->pageNumber == accessedPage;
+            if (it->PID == currentPID && !accessed && prefetchedPages.count({it->PID, it->pageNumber}) == 0) {
+                evictMemoryItem(it);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+        @return : the lowest free frame number, reusing frames released by evicted or terminated memory items
+    */
+    unsigned long long allocateFrame(){
+        if (freeFrames.empty()) {
+            return frameCounter++;
+        }
+
+        unsigned long long frameNumber = *freeFrames.begin();
+        freeFrames.erase(freeFrames.begin());
+        return frameNumber;
     }
 
     /**
@@ -387,6 +661,8 @@ class SimOS
         auto it = memoryUsage.begin();
         while (it != memoryUsage.end()) {
             if (it->PID == itemToDelete.PID && it->pageNumber == itemToDelete.pageNumber && it->frameNumber == itemToDelete.frameNumber) {
+                freeFrames.insert(it->frameNumber);
+                residentPages.erase({it->PID, it->pageNumber});
                 it = memoryUsage.erase(it);
                 break;
             } else {
@@ -399,13 +675,7 @@ class SimOS
         @return : returns true if the page address is in memory, false otherwise
     */
     bool isPageAddressInMemory(unsigned long long address){
-        for (auto item : memoryUsage) {
-            if (item.PID == currentPID && item.pageNumber == address) {
-                return true;
-            }
-        }
-
-        return false;
+        return residentPages.count({currentPID, address}) > 0;
     }
 
     /**
@@ -423,12 +693,25 @@ class SimOS
         auto it = memoryUsage.begin();
         while (it != memoryUsage.end()) {
             if (it->PID == pid) {
+                freeFrames.insert(it->frameNumber);
+                residentPages.erase({it->PID, it->pageNumber});
                 it = memoryUsage.erase(it);
             } else {
                 ++it;
             }
         }
 
+        auto lruIt = lruList.begin();
+        while (lruIt != lruList.end()) {
+            if (lruIt->PID == pid) {
+                prefetchedPages.erase({pid, lruIt->pageNumber});
+                lruIt = lruList.erase(lruIt);
+            } else {
+                ++lruIt;
+            }
+        }
+        readaheadStates.erase(pid);
+
         for (int child : childrenToDelete) {
             processTable.erase(child);
         }
@@ -449,6 +732,24 @@ class SimOS
         return sortedMemoryUsage;
     }
 
+    /**
+           @param : The largest number of pages read ahead per process (a unsigned int)
+           @param : The number of times in a row a stride must be seen before reading ahead (a unsigned int)
+
+            @post : Sets the readahead window limit and the sequential threshold, 0 for either disables readahead
+                Readahead is disabled until this is called, a quarter of the frames in RAM is a reasonable window limit
+                The window limit also caps the pages each process may have prefetched but not yet accessed
+    */
+    void SetReadahead(unsigned int maxWindow, unsigned int threshold){
+        readaheadWindowLimit = maxWindow;
+        sequentialThreshold = threshold;
+    }
+
+    /* Returns the readahead counters, used to tune the readahead window against the miss rate */
+    PrefetchStats GetPrefetchStats() const {
+        return prefetchStats;
+    }
+
     /* Returns the ReadyQueue */
     std::deque<int> GetReadyQueue(){
         return readyQueue;
@@ -462,7 +763,15 @@ class SimOS
         int maxFrames; 
         MemoryUsage memoryUsage;
         std::deque<MemoryItem> lruList;
-        int frameCounter = 0;
+        std::set<unsigned long long> freeFrames; // Frames below frameCounter that were released
+        unsigned long long frameCounter = 0;     // Next frame number that has never been used
+
+        std::unordered_map<int, ReadaheadState> readaheadStates;
+        std::set<std::pair<int, unsigned long long>> residentPages;   // (PID, pageNumber) of every memory item
+        std::set<std::pair<int, unsigned long long>> prefetchedPages; // (PID, pageNumber) prefetched but not yet accessed
+        PrefetchStats prefetchStats;
+        unsigned int readaheadWindowLimit = 0; // Readahead is off until SetReadahead is called
+        unsigned int sequentialThreshold = DEFAULT_SEQUENTIAL_THRESHOLD;
 
         std::deque<int> readyQueue; 
         std::vector<Disk> disks;